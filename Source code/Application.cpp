@@ -10,13 +10,20 @@
 --					LRESULT CALLBACK WndProc (HWND hwnd, UINT Message,
 --                        WPARAM wParam, LPARAM lParam)
 --					void DrawToStatusBar(char statusText[1000])
+--					void DrawToStatusBarPart(int part, char statusText[1000])
+--					BOOL WaitAndPumpMessages(HANDLE hObject, DWORD timeout)
 --					HWND CreateSimpleToolbar(HINSTANCE hInst, HWND hWndParent)
 --					HWND CreateListView(HINSTANCE hInst, HWND hWndParent) 
 --					HWND CreateStatusBar(HINSTANCE hInst, HWND hWndParent)
 --
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Start and Stop use the session pool, which
+--								   is created and shut down around the
+--								   message loop.
+--					October 19, 2026 - Starts and shuts down the tag event
+--								   pipeline.
+--					October 19, 2026 - Shutdown waits keep dispatching messages.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -58,8 +65,6 @@ HWND hwnd;
 HWND hwndStatus;
 HWND hwndListView;
 HWND hWndToolbar;
-HANDLE tagThreadHandle;
-DWORD threadId;
 RECT rcWindow;
 LVCOLUMN lvc;
 LVITEM   lv;
@@ -69,7 +74,9 @@ LVITEM   lv;
 --
 --	DATE:			October 19, 2015
 --					
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Starts the session pool before the message
+--								   loop and shuts it down after.
+--					October 19, 2026 - Does the same for the tag event pipeline.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -131,6 +138,10 @@ int WINAPI WinMain (HINSTANCE hInst, HINSTANCE hprevInstance,
 	CreateStatusBar(hInst, hwnd);
 	CreateSimpleToolbar(hInst, hwnd);
 
+	// start the threads that process tag reads, then those that run reader sessions
+	if (!InitPipeline() || !InitSessionPool(SESSION_POOL_THREADS))
+		return 0;
+
 	// set application icon
 	HANDLE icon = LoadImage(NULL, "menu_icon.ico", IMAGE_ICON, 32, 32, LR_LOADFROMFILE);
 	SendMessage(hwnd, WM_SETICON, ICON_BIG, (LPARAM)icon);
@@ -146,6 +157,12 @@ int WINAPI WinMain (HINSTANCE hInst, HINSTANCE hprevInstance,
 		DispatchMessage (&Msg); // dispatch message and return control to windows
 	}
 
+	// destroy the window first, so sessions still running do not wait on it
+	if (IsWindow(hwnd))
+		DestroyWindow(hwnd);
+	ShutdownSessionPool();
+	ShutdownPipeline();
+
 	return Msg.wParam;
 }
 
@@ -154,7 +171,8 @@ int WINAPI WinMain (HINSTANCE hInst, HINSTANCE hprevInstance,
 --
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - The paint DC is local, no longer shared with
+--								   the reader threads.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -171,6 +189,7 @@ LRESULT CALLBACK WndProc (HWND hwnd, UINT Message,
                           WPARAM wParam, LPARAM lParam)
 {
 	PAINTSTRUCT paintstruct;
+	HDC hdc;
 
 	switch (Message)
 	{
@@ -181,14 +200,14 @@ LRESULT CALLBACK WndProc (HWND hwnd, UINT Message,
 					MessageBox(hwnd, HelpMessage, "Help", MB_OK);
 					break;
 				case IDM_START_BUTTON:
-					tagThreadHandle = CreateThread(NULL, 0, DiscoverDevices, NULL, 0, &threadId);
+					StartScanning();
 					break;
 				case IDM_STOP_BUTTON:
-					StopScanning(tagThreadHandle);
+					StopScanning();
 					break;
 				case IDM_CLEAR_BUTTON:
 					ListView_DeleteAllItems(hwndListView);
-					listCounter = 0;
+					InterlockedExchange(&listCounter, 0);
 					DrawToStatusBar("Tags cleared");
 					break;
 				case IDM_EXIT_BUTTON:
@@ -228,7 +247,7 @@ LRESULT CALLBACK WndProc (HWND hwnd, UINT Message,
 --
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Writes to the message part of the status bar.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -241,7 +260,75 @@ LRESULT CALLBACK WndProc (HWND hwnd, UINT Message,
 --	NOTES:			Sets the text of the status bar.
 -----------------------------------------------------------------------------------*/
 void DrawToStatusBar(char statusText[1000]) {
-	SendMessage(hwndStatus, SB_SETTEXT, 0, (LPARAM)statusText);
+	DrawToStatusBarPart(STATUS_PART_MESSAGE, statusText);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DrawToStatusBarPart
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void DrawToStatusBarPart(int part, char statusText[1000])
+--
+--	RETURNS:		void
+--
+--	NOTES:			Sets the text of one part of the status bar. Text in the recovery
+--					part stays until the next reconnect, as progress messages only
+--					replace the message part.
+-----------------------------------------------------------------------------------*/
+void DrawToStatusBarPart(int part, char statusText[1000]) {
+	SendMessage(hwndStatus, SB_SETTEXT, part, (LPARAM)statusText);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: WaitAndPumpMessages
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL WaitAndPumpMessages(HANDLE hObject, DWORD timeout)
+--
+--	RETURNS:		BOOL - TRUE if the object was signalled before the timeout
+--
+--	NOTES:			Waits up to timeout ms for hObject, dispatching any messages sent
+--					to this thread in the meantime. Used on the UI thread at shutdown,
+--					so a worker sending to a window cannot deadlock against the wait.
+-----------------------------------------------------------------------------------*/
+BOOL WaitAndPumpMessages(HANDLE hObject, DWORD timeout) {
+	MSG Msg;
+	DWORD start = GetTickCount();
+	DWORD elapsed;
+
+	for (;;) {
+		elapsed = GetTickCount() - start;
+		if (elapsed >= timeout) {
+			return (WaitForSingleObject(hObject, 0) == WAIT_OBJECT_0);
+		}
+
+		switch (MsgWaitForMultipleObjects(1, &hObject, FALSE, timeout - elapsed, QS_ALLINPUT)) {
+			case WAIT_OBJECT_0:
+				return TRUE;
+			case WAIT_OBJECT_0 + 1:
+				while (PeekMessage(&Msg, NULL, 0, 0, PM_REMOVE)) {
+					TranslateMessage(&Msg);
+					DispatchMessage(&Msg);
+				}
+				break;
+			default:
+				return FALSE;
+		}
+	}
 }
 
 /*-----------------------------------------------------------------------------------
@@ -389,7 +476,8 @@ HWND CreateListView(HINSTANCE hInst, HWND hWndParent) {
 --
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Split into a message part and a reader
+--								   recovery part.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -402,6 +490,8 @@ HWND CreateListView(HINSTANCE hInst, HWND hWndParent) {
 --	NOTES:			Initializes the status bar for displaying status messages.
 -----------------------------------------------------------------------------------*/
 HWND CreateStatusBar(HINSTANCE hInst, HWND hWndParent) {
+	int partEdges[] = { STATUS_MESSAGE_WIDTH, -1 };
+
 	// Create the status bar.
 	hwndStatus = CreateWindowEx(
 		0,								   // no extended styles
@@ -415,6 +505,7 @@ HWND CreateStatusBar(HINSTANCE hInst, HWND hWndParent) {
 		NULL);							   // no window creation data
 
 	SetWindowPos(hwndStatus, HWND_TOP, 0, 10, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+	SendMessage(hwndStatus, SB_SETPARTS, 2, (LPARAM)partEdges);
 
 	return hwndStatus;
 }
\ No newline at end of file
@@ -7,9 +7,19 @@
 --	FUNCTIONS:
 --					unsigned char SelectLoopCallback(LPSKYETEK_TAG lpTag, void *user)
 --
+--					With SIMULATED_READER, this file also defines the SimReader_
+--					functions, which stand in for the SkyeTek API calls of the same
+--					name.
+--
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Stop is taken from the session layer, and rows
+--								   are claimed atomically so several reader
+--								   sessions can display at once.
+--					October 19, 2026 - Added simulated readers for the
+--								   SIMULATED_READER build.
+--					October 19, 2026 - Decoding and display moved to the
+--								   Presentation layer.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -34,18 +44,17 @@
 #include "header.h"
 
 // declared variables
-HDC hdc;
-char tagTypeBuffer[2];
-char idBuffer[2];
-bool isStop = FALSE;
-int listCounter = 0;
+volatile LONG listCounter = 0;
 
 /*-----------------------------------------------------------------------------------
 --	FUNCTION: SelectLoopCallback
 --
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Called from the session pool; user is the
+--								   LPREADER_SESSION the tag was read by.
+--					October 19, 2026 - Hands the read to the tag event pipeline
+--								   instead of decoding and displaying it.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -56,62 +65,465 @@ int listCounter = 0;
 --	RETURNS:		unsigned char
 --
 --	NOTES:			Callback function called by SelectTags when a tag has been found.  This 
---					function handles retrieving the tag data and inserting it into the
---					listview for display.
+--					function copies the tag data into the tag event pipeline, which
+--					decodes it and inserts it into the listview for display on its own
+--					threads (see Presentation.cpp).
 -----------------------------------------------------------------------------------*/
 unsigned char SelectLoopCallback(LPSKYETEK_TAG lpTag, void *user) {
-	char counterBuffer[40];
-	LPSTR friendlyLPSTR, typeLPSTR;
-	string friendlyString, typeString;
-
-	if (!isStop) {
-		if (lpTag != NULL) {
-			DrawToStatusBar("Reading tags.....");
-			hdc = GetDC(hwnd);
-
-			// get friendly text from tag
-			for (int i = 0; i < sizeof(lpTag->friendly); i++) {
-				sprintf_s(idBuffer, "%s", lpTag->friendly+i);
-				if (idBuffer[0] == '\0') {
-					continue;
-				}
-
-				// convert char buffer and add to string
-				friendlyString += idBuffer;
-				// convert string to lpstr to pass into ListView_SetItemText
-				friendlyLPSTR = const_cast<char *>(friendlyString.c_str());
-			}
-
-			// get type text from tag
-			for (int i = 0; i < (sizeof(SkyeTek_GetTagTypeNameFromType(lpTag->type)) * 16); i++) {
-				sprintf_s(tagTypeBuffer, "%s", SkyeTek_GetTagTypeNameFromType(lpTag->type) + i);
-
-				if (tagTypeBuffer[0] == '\0') {
-					continue;
-				}
-
-				// convert char buffer and add to string
-				typeString += tagTypeBuffer;
-
-				// convert string to lpstr to pass into ListView_SetItemText
-				typeLPSTR = const_cast<char *>(typeString.c_str());
-			}
-
-			lv.iItem = listCounter;
-			sprintf_s(counterBuffer, "%d", listCounter);
-			ListView_InsertItem(hwndListView, &lv);
-
-			// sets counter, id, and type (displays on screen)
-			ListView_SetItemText(hwndListView, listCounter, 0, counterBuffer);
-			ListView_SetItemText(hwndListView, listCounter, 1, friendlyLPSTR);
-			ListView_SetItemText(hwndListView, listCounter, 2, typeLPSTR);
-
-			// increment counter (row)
-			listCounter++;
-			
-			ReleaseDC((HWND)hwnd, hdc);
-			SkyeTek_FreeTag(lpTag);
+	LPREADER_SESSION lpSession = (LPREADER_SESSION)user;
+
+	if (lpTag != NULL) {
+		if (!stopRequested) {
+			PostTagEvent(lpTag, lpSession->index);
+		}
+		SkyeTek_FreeTag(lpTag);
+	}
+	return (!stopRequested);
+}
+
+#ifdef SIMULATED_READER
+#define SIM_READERS			2		// simulated readers found by discovery
+#define SIM_PASS_TIME		20		// ms a simulated select pass takes
+#define SIM_FAULT_ODDS		100		// one pass in this many disconnects, one more stalls
+#define SIM_UNPLUGGED_MAX	3000	// ms a disconnected reader stays unplugged, at most
+#define SIM_TAG_PERIOD		100		// ms each tag stays in the field before the next arrives
+
+// Simulated device. The SkyeTek device comes first, so the two pointers convert.
+typedef struct {
+	SKYETEK_DEVICE device;
+	int index;						// position in the discovered list
+	volatile LONG isOpen;			// cleared by SimReader_CloseDevice
+	volatile DWORD unpluggedUntil;	// tick count the device comes back, if unplugged
+	volatile DWORD stalledThread;	// ID of the thread in a stalled pass, 0 if none
+	volatile LONG isCancelled;		// set by SimReader_CancelSynchronousIo
+	DWORD fieldStarted;				// tick count the first tag entered the field
+	unsigned int nextTag;			// lowest sequence number not yet read
+} SIM_DEVICE, *LPSIM_DEVICE;
+
+LPSIM_DEVICE simDevices[SIM_READERS];	// discovered devices, for cancelling stalled passes
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_IsUnplugged
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL SimReader_IsUnplugged(LPSIM_DEVICE lpSim)
+--
+--	RETURNS:		BOOL - TRUE while the simulated device is disconnected
+--
+--	NOTES:			Compares tick counts by difference, so it holds across the
+--					tick count wrapping.
+-----------------------------------------------------------------------------------*/
+BOOL SimReader_IsUnplugged(LPSIM_DEVICE lpSim) {
+	return ((LONG)(lpSim->unpluggedUntil - GetTickCount()) > 0);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_DiscoverDevices
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		unsigned int SimReader_DiscoverDevices(LPSKYETEK_DEVICE **lpDevices)
+--
+--	RETURNS:		unsigned int - number of devices
+--
+--	NOTES:			Creates SIM_READERS open, connected simulated devices.
+-----------------------------------------------------------------------------------*/
+unsigned int SimReader_DiscoverDevices(LPSKYETEK_DEVICE **lpDevices) {
+	*lpDevices = (LPSKYETEK_DEVICE *)calloc(SIM_READERS, sizeof(LPSKYETEK_DEVICE));
+
+	for (int i = 0; i < SIM_READERS; i++) {
+		LPSIM_DEVICE lpSim = (LPSIM_DEVICE)calloc(1, sizeof(SIM_DEVICE));
+		lpSim->index = i;
+		lpSim->isOpen = TRUE;
+		lpSim->unpluggedUntil = GetTickCount();
+		lpSim->fieldStarted = GetTickCount();
+		(*lpDevices)[i] = &lpSim->device;
+		simDevices[i] = lpSim;
+	}
+
+	return SIM_READERS;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_DiscoverReaders
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		unsigned int SimReader_DiscoverReaders(LPSKYETEK_DEVICE *lpDevices,
+--						unsigned int count, LPSKYETEK_READER **lpReaders)
+--
+--	RETURNS:		unsigned int - number of readers
+--
+--	NOTES:			Creates one reader on each simulated device.
+-----------------------------------------------------------------------------------*/
+unsigned int SimReader_DiscoverReaders(LPSKYETEK_DEVICE *lpDevices, unsigned int count,
+	LPSKYETEK_READER **lpReaders) {
+	*lpReaders = (LPSKYETEK_READER *)calloc(count, sizeof(LPSKYETEK_READER));
+
+	for (unsigned int i = 0; i < count; i++) {
+		SimReader_CreateReader(lpDevices[i], &(*lpReaders)[i]);
+	}
+
+	return count;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_FreeDevices
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void SimReader_FreeDevices(LPSKYETEK_DEVICE *lpDevices,
+--						unsigned int count)
+--
+--	RETURNS:		void
+-----------------------------------------------------------------------------------*/
+void SimReader_FreeDevices(LPSKYETEK_DEVICE *lpDevices, unsigned int count) {
+	if (lpDevices == NULL) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		simDevices[((LPSIM_DEVICE)lpDevices[i])->index] = NULL;
+		free((LPSIM_DEVICE)lpDevices[i]);
+	}
+	free(lpDevices);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_FreeReaders
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void SimReader_FreeReaders(LPSKYETEK_READER *lpReaders,
+--						unsigned int count)
+--
+--	RETURNS:		void
+-----------------------------------------------------------------------------------*/
+void SimReader_FreeReaders(LPSKYETEK_READER *lpReaders, unsigned int count) {
+	if (lpReaders == NULL) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		SimReader_FreeReader(lpReaders[i]);
+	}
+	free(lpReaders);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_OpenDevice
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		SKYETEK_STATUS SimReader_OpenDevice(LPSKYETEK_DEVICE lpDevice)
+--
+--	RETURNS:		SKYETEK_STATUS
+--
+--	NOTES:			Fails while the simulated device is unplugged.
+-----------------------------------------------------------------------------------*/
+SKYETEK_STATUS SimReader_OpenDevice(LPSKYETEK_DEVICE lpDevice) {
+	LPSIM_DEVICE lpSim = (LPSIM_DEVICE)lpDevice;
+
+	if (SimReader_IsUnplugged(lpSim)) {
+		return SKYETEK_READER_IO_ERROR;
+	}
+
+	InterlockedExchange(&lpSim->isOpen, TRUE);
+	return SKYETEK_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_CloseDevice
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		SKYETEK_STATUS SimReader_CloseDevice(LPSKYETEK_DEVICE lpDevice)
+--
+--	RETURNS:		SKYETEK_STATUS
+--
+-----------------------------------------------------------------------------------*/
+SKYETEK_STATUS SimReader_CloseDevice(LPSKYETEK_DEVICE lpDevice) {
+	InterlockedExchange(&((LPSIM_DEVICE)lpDevice)->isOpen, FALSE);
+	return SKYETEK_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_CreateReader
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		SKYETEK_STATUS SimReader_CreateReader(LPSKYETEK_DEVICE lpDevice,
+--						LPSKYETEK_READER *lpReader)
+--
+--	RETURNS:		SKYETEK_STATUS
+-----------------------------------------------------------------------------------*/
+SKYETEK_STATUS SimReader_CreateReader(LPSKYETEK_DEVICE lpDevice, LPSKYETEK_READER *lpReader) {
+	if (!((LPSIM_DEVICE)lpDevice)->isOpen) {
+		return SKYETEK_READER_IO_ERROR;
+	}
+
+	*lpReader = (LPSKYETEK_READER)calloc(1, sizeof(SKYETEK_READER));
+	(*lpReader)->lpDevice = lpDevice;
+	return SKYETEK_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_FreeReader
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void SimReader_FreeReader(LPSKYETEK_READER lpReader)
+--
+--	RETURNS:		void
+-----------------------------------------------------------------------------------*/
+void SimReader_FreeReader(LPSKYETEK_READER lpReader) {
+	free(lpReader);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_SelectTags
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		SKYETEK_STATUS SimReader_SelectTags(LPSKYETEK_READER lpReader,
+--						SKYETEK_TAGTYPE tagType, SKYETEK_TAG_SELECT_CALLBACK callback,
+--						unsigned char inv, unsigned char loop, void *user)
+--
+--	RETURNS:		SKYETEK_STATUS
+--
+--	NOTES:			One select pass. Now and then the device unplugs itself for up to
+--					SIM_UNPLUGGED_MAX, or the pass stalls until its I/O is cancelled.
+--					Otherwise the tag in the field is read, unless it already was.
+--
+--					A new tag enters the field every SIM_TAG_PERIOD, whether or not
+--					the reader is connected, and its ID holds the reader index and
+--					its sequence number. Tags that passed while the reader was
+--					unplugged or stalled show as a gap in the list, and a read lost
+--					or delivered twice by the session shows as a gap or a repeat.
+-----------------------------------------------------------------------------------*/
+SKYETEK_STATUS SimReader_SelectTags(LPSKYETEK_READER lpReader, SKYETEK_TAGTYPE tagType,
+	SKYETEK_TAG_SELECT_CALLBACK callback, unsigned char inv, unsigned char loop, void *user) {
+	LPSIM_DEVICE lpSim = (LPSIM_DEVICE)lpReader->lpDevice;
+	LPSKYETEK_TAG lpTag;
+	unsigned int inField;			// sequence number of the tag now in the field
+	int chance = rand() % SIM_FAULT_ODDS;
+
+	if (!lpSim->isOpen || SimReader_IsUnplugged(lpSim)) {
+		return SKYETEK_READER_IO_ERROR;
+	}
+
+	if (chance == 0) {
+		lpSim->unpluggedUntil = GetTickCount() + rand() % SIM_UNPLUGGED_MAX;
+		return SKYETEK_READER_IO_ERROR;
+	}
+
+	if (chance == 1) {
+		InterlockedExchange(&lpSim->isCancelled, FALSE);
+		lpSim->stalledThread = GetCurrentThreadId();
+		while (!InterlockedExchange(&lpSim->isCancelled, FALSE)) {
+			Sleep(SIM_PASS_TIME);
 		}
+		lpSim->stalledThread = 0;
+		return SKYETEK_READER_IO_ERROR;
 	}
-	return (!isStop);
-}
\ No newline at end of file
+
+	Sleep(SIM_PASS_TIME);
+
+	inField = (GetTickCount() - lpSim->fieldStarted) / SIM_TAG_PERIOD;
+	if (inField < lpSim->nextTag) {
+		return SKYETEK_TAG_NOT_IN_FIELD;
+	}
+
+	lpTag = (LPSKYETEK_TAG)calloc(1, sizeof(SKYETEK_TAG));
+	lpTag->type = tagType;
+	sprintf_s(lpTag->friendly, "SIM%d-%08u", lpSim->index, inField);
+	lpSim->nextTag = inField + 1;
+	callback(lpTag, user);
+
+	return SKYETEK_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_GetSystemParameter
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		SKYETEK_STATUS SimReader_GetSystemParameter(LPSKYETEK_READER lpReader,
+--						SKYETEK_SYSTEM_PARAMETER parameter, LPSKYETEK_DATA *lpData)
+--
+--	RETURNS:		SKYETEK_STATUS
+--
+--	NOTES:			Answers only while the device is open and plugged in. No data is
+--					returned, as the session only checks that the reader answers.
+-----------------------------------------------------------------------------------*/
+SKYETEK_STATUS SimReader_GetSystemParameter(LPSKYETEK_READER lpReader,
+	SKYETEK_SYSTEM_PARAMETER parameter, LPSKYETEK_DATA *lpData) {
+	LPSIM_DEVICE lpSim = (LPSIM_DEVICE)lpReader->lpDevice;
+
+	*lpData = NULL;
+
+	if (!lpSim->isOpen || SimReader_IsUnplugged(lpSim)) {
+		return SKYETEK_READER_IO_ERROR;
+	}
+
+	return SKYETEK_SUCCESS;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_FreeData
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void SimReader_FreeData(LPSKYETEK_DATA lpData)
+--
+--	RETURNS:		void
+-----------------------------------------------------------------------------------*/
+void SimReader_FreeData(LPSKYETEK_DATA lpData) {
+	free(lpData);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_FreeTag
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void SimReader_FreeTag(LPSKYETEK_TAG lpTag)
+--
+--	RETURNS:		void
+-----------------------------------------------------------------------------------*/
+void SimReader_FreeTag(LPSKYETEK_TAG lpTag) {
+	free(lpTag);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_GetTagTypeNameFromType
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		TCHAR *SimReader_GetTagTypeNameFromType(SKYETEK_TAGTYPE type)
+--
+--	RETURNS:		TCHAR * - name of the tag type
+-----------------------------------------------------------------------------------*/
+TCHAR *SimReader_GetTagTypeNameFromType(SKYETEK_TAGTYPE type) {
+	static TCHAR typeName[] = TEXT("Simulated Tag");
+
+	return typeName;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SimReader_CancelSynchronousIo
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL SimReader_CancelSynchronousIo(HANDLE hThread)
+--
+--	RETURNS:		BOOL - TRUE if a stalled pass was cancelled
+--
+--	NOTES:			Stands in for CancelSynchronousIo, releasing the stalled pass
+--					running on hThread with an I/O error, as cancelling the blocked
+--					read of a real device does.
+-----------------------------------------------------------------------------------*/
+BOOL SimReader_CancelSynchronousIo(HANDLE hThread) {
+	DWORD threadId = GetThreadId(hThread);
+
+	for (int i = 0; i < SIM_READERS; i++) {
+		if (simDevices[i] != NULL && simDevices[i]->stalledThread == threadId) {
+			InterlockedExchange(&simDevices[i]->isCancelled, TRUE);
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+#endif
@@ -0,0 +1,993 @@
+/*-----------------------------------------------------------------------------------
+--	SOURCE FILE:	Presentation.cpp - Presentation layer of an RFID reader application,
+--								  decoding tag reads and presenting them to the user.
+--
+--	PROGRAM:        RFID Reader Application
+--
+--	FUNCTIONS:
+--					BOOL InitPipeline(void)
+--					void ShutdownPipeline(void)
+--					BOOL PostTagEvent(LPSKYETEK_TAG lpTag, int reader)
+--					BOOL PipelineHasRoom(int events)
+--					int RegisterStages(char *stageList)
+--					DWORD WINAPI PipelineWorker(LPVOID lpParameter)
+--					void RunStage(int index)
+--					LPTAG_BATCH PopBatch(int index)
+--					BOOL PushBatch(int index, LPTAG_BATCH lpBatch)
+--					void ScheduleStage(int index)
+--					void SealBatch(void)
+--					void ScheduleFeed(void)
+--					void RunFeed(void)
+--					void CALLBACK FlushTimerCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
+--					int DecodeStage(LPTAG_EVENT lpEvents, int count)
+--					int DedupeStage(LPTAG_EVENT lpEvents, int count)
+--					int DisplayStage(LPTAG_EVENT lpEvents, int count)
+--					int StatusStage(LPTAG_EVENT lpEvents, int count)
+--					int ExportStage(LPTAG_EVENT lpEvents, int count)
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	NOTES:			Presentation.cpp is part of an RFID reader application, that uses
+--					the SkeyeTek API to connect to an RFID device, and allows for the
+--					reading of RFID tags and printing the tag ID and type onto the
+--					screen.
+--
+--					This program utilizes the layered (OSI) approach. This file makes
+--					up the Presentation layer of this model, responsible for turning
+--					tag reads into the text shown on screen, off the reader's thread.
+--
+--					Reads are copied into batches of plain TAG_EVENT records, and each
+--					batch is passed through a pipeline of stages. Every stage has its
+--					own queue of at most PIPELINE_QUEUE_DEPTH batches. A stage whose
+--					next queue is full holds its batch until that stage makes room,
+--					so a slow stage pushes back on the ones before it, and finally on
+--					the readers, which wait while PipelineHasRoom is FALSE. A stage
+--					only runs on one worker at a time, so batches stay in order.
+--
+--					The readers only take the source lock, which guards the filling
+--					batch, the sealed batches and the pool. Sealed batches are moved
+--					into the first queue by a feed work item on a pipeline thread, so
+--					a reader never waits on the stage queues. Where both locks are
+--					needed, the pipeline lock is taken first.
+--
+--					The stages and number of worker threads are read from the
+--					[Pipeline] section of RFIDReader.ini, for example:
+--
+--						[Pipeline]
+--						Threads=2
+--						Stages=decode,dedupe,display,status,export
+--
+--					Stages run in the order listed. decode must come first, and each
+--					stage can only be listed once. Without the file, or if the list
+--					is not valid, the stages in PIPELINE_STAGES are run, and without
+--					Threads, PIPELINE_THREADS threads are used.
+-----------------------------------------------------------------------------------*/
+
+#define STRICT
+
+#include <windows.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "header.h"
+
+// Pipeline stage, with the queue of batches waiting for it
+typedef struct {
+	PIPELINE_ROUTINE routine;
+	LPTAG_BATCH queue[PIPELINE_QUEUE_DEPTH];
+	int head;						// oldest batch in the queue
+	int count;						// batches in the queue
+	LPTAG_BATCH lpBlocked;			// batch waiting for room in the next stage's queue
+	BOOL isScheduled;				// TRUE while queued on or running on a worker
+} PIPELINE_STAGE, *LPPIPELINE_STAGE;
+
+// Completion key of the feed work item; stage keys are the stage index plus one
+#define PIPELINE_FEED_KEY	(PIPELINE_MAX_STAGES + 1)
+
+// Last read of a tag by a reader, kept by the dedupe stage
+typedef struct {
+	BOOL isUsed;
+	int reader;
+	DWORD tick;						// tick count of the last read
+	char id[TAG_ID_LENGTH];
+} DEDUPE_ENTRY, *LPDEDUPE_ENTRY;
+
+// Stage names that can be used in RFIDReader.ini
+typedef struct {
+	const char *name;
+	PIPELINE_ROUTINE routine;
+} STAGE_ENTRY;
+
+// function prototype
+int RegisterStages(char *stageList);
+DWORD WINAPI PipelineWorker(LPVOID lpParameter);
+void RunStage(int index);
+LPTAG_BATCH PopBatch(int index);
+BOOL PushBatch(int index, LPTAG_BATCH lpBatch);
+void ScheduleStage(int index);
+void SealBatch(void);
+void ScheduleFeed(void);
+void RunFeed(void);
+void CALLBACK FlushTimerCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired);
+int DecodeStage(LPTAG_EVENT lpEvents, int count);
+int DedupeStage(LPTAG_EVENT lpEvents, int count);
+int DisplayStage(LPTAG_EVENT lpEvents, int count);
+int StatusStage(LPTAG_EVENT lpEvents, int count);
+int ExportStage(LPTAG_EVENT lpEvents, int count);
+
+// declared variables
+const STAGE_ENTRY stageTable[] = {
+	{ "decode",  DecodeStage },
+	{ "dedupe",  DedupeStage },
+	{ "display", DisplayStage },
+	{ "status",  StatusStage },
+	{ "export",  ExportStage }
+};
+
+PIPELINE_STAGE stages[PIPELINE_MAX_STAGES];
+int numStages = 0;
+
+TAG_BATCH batches[PIPELINE_BATCHES];
+LPTAG_BATCH freeBatches[PIPELINE_BATCHES];
+int numFreeBatches = 0;
+LPTAG_BATCH lpFilling = NULL;		// batch reads are being added to
+LPTAG_BATCH sealedBatches[PIPELINE_BATCHES];	// batches waiting to be fed to the first stage
+int sealedHead = 0;					// oldest sealed batch
+int numSealed = 0;
+HANDLE hDrained = NULL;				// signalled while every batch is back in the pool
+
+CRITICAL_SECTION sourceLock;		// guards the filling, sealed and free batches above
+CRITICAL_SECTION pipelineLock;		// guards the stage queues and stage states
+HANDLE hPipelinePort = NULL;
+HANDLE pipelineThreads[PIPELINE_MAX_THREADS];
+int numPipelineThreads = 0;
+HANDLE hFlushTimer = NULL;
+volatile LONG feedScheduled = 0;	// TRUE while a feed work item is queued
+volatile LONG droppedEvents = 0;
+
+DEDUPE_ENTRY dedupeTable[PIPELINE_DEDUPE_SLOTS];	// only used by the dedupe stage
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: InitPipeline
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL InitPipeline(void)
+--
+--	RETURNS:		BOOL - TRUE if the pipeline was started
+--
+--	NOTES:			Registers the configured stages, falling back to PIPELINE_STAGES
+--					if they are not valid. Fills the batch pool, and starts the worker
+--					threads and the timer that sends on partly filled batches. Called
+--					once at startup.
+-----------------------------------------------------------------------------------*/
+BOOL InitPipeline(void) {
+	char stageList[256];
+	int numThreads;
+
+	GetPrivateProfileString("Pipeline", "Stages", PIPELINE_STAGES, stageList,
+		sizeof(stageList), PIPELINE_CONFIG_FILE);
+
+	if (RegisterStages(stageList) == 0) {
+		DrawToStatusBar("Stages in RFIDReader.ini are not valid, using the default stages.....");
+		strcpy_s(stageList, PIPELINE_STAGES);
+		RegisterStages(stageList);
+	}
+
+	numThreads = GetPrivateProfileInt("Pipeline", "Threads", PIPELINE_THREADS, PIPELINE_CONFIG_FILE);
+	numThreads = max(1, min(numThreads, PIPELINE_MAX_THREADS));
+
+	InitializeCriticalSection(&sourceLock);
+	InitializeCriticalSection(&pipelineLock);
+	hDrained = CreateEvent(NULL, TRUE, TRUE, NULL);
+
+	for (numFreeBatches = 0; numFreeBatches < PIPELINE_BATCHES; numFreeBatches++) {
+		freeBatches[numFreeBatches] = &batches[numFreeBatches];
+	}
+
+	hPipelinePort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, numThreads);
+	if (hPipelinePort == NULL) {
+		return FALSE;
+	}
+
+	for (numPipelineThreads = 0; numPipelineThreads < numThreads; numPipelineThreads++) {
+		pipelineThreads[numPipelineThreads] = CreateThread(NULL, 0, PipelineWorker, NULL, 0, NULL);
+		if (pipelineThreads[numPipelineThreads] == NULL) {
+			break;
+		}
+	}
+
+	CreateTimerQueueTimer(&hFlushTimer, NULL, FlushTimerCallback, NULL, PIPELINE_FLUSH_PERIOD,
+		PIPELINE_FLUSH_PERIOD, WT_EXECUTEDEFAULT);
+
+	return (numPipelineThreads > 0);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: ShutdownPipeline
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void ShutdownPipeline(void)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Sends on the last partly filled batch, waits up to
+--					PIPELINE_DRAIN_TIMEOUT for the batches in flight to finish, then
+--					stops the worker threads. Called on the UI thread after the session
+--					pool has been shut down, so no more reads arrive; the waits keep
+--					dispatching messages, as the display stage sends to the listview.
+--					If a worker is still running, the port, event and locks it uses
+--					are left for the process exit to reclaim.
+-----------------------------------------------------------------------------------*/
+void ShutdownPipeline(void) {
+	BOOL isIdle;
+
+	if (hFlushTimer != NULL) {
+		DeleteTimerQueueTimer(NULL, hFlushTimer, INVALID_HANDLE_VALUE);
+		hFlushTimer = NULL;
+	}
+
+	EnterCriticalSection(&sourceLock);
+	SealBatch();
+	LeaveCriticalSection(&sourceLock);
+
+	isIdle = WaitAndPumpMessages(hDrained, PIPELINE_DRAIN_TIMEOUT);
+
+	for (int i = 0; i < numPipelineThreads; i++) {
+		PostQueuedCompletionStatus(hPipelinePort, 0, 0, NULL);
+	}
+
+	for (int i = 0; i < numPipelineThreads; i++) {
+		if (!WaitAndPumpMessages(pipelineThreads[i], PIPELINE_DRAIN_TIMEOUT)) {
+			isIdle = FALSE;
+		}
+	}
+
+	if (!isIdle) {
+		return;
+	}
+
+	for (int i = 0; i < numPipelineThreads; i++) {
+		CloseHandle(pipelineThreads[i]);
+	}
+
+	CloseHandle(hPipelinePort);
+	CloseHandle(hDrained);
+	DeleteCriticalSection(&pipelineLock);
+	DeleteCriticalSection(&sourceLock);
+	numPipelineThreads = 0;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: RegisterStages
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		int RegisterStages(char *stageList)
+--
+--	RETURNS:		int - number of stages registered
+--
+--	NOTES:			Looks up each name in a comma separated list of stages, and adds
+--					the stage to the end of the pipeline. The list is rejected, and no
+--					stages are registered, if it names an unknown stage, names a stage
+--					twice, has more than PIPELINE_MAX_STAGES stages, or does not start
+--					with decode, which the other stages depend on.
+-----------------------------------------------------------------------------------*/
+int RegisterStages(char *stageList) {
+	const int numEntries = sizeof(stageTable) / sizeof(stageTable[0]);
+	BOOL isListed[numEntries] = { FALSE };
+	char *context = NULL;
+	char *name;
+	int entry;
+
+	numStages = 0;
+
+	for (name = strtok_s(stageList, ", ", &context); name != NULL; name = strtok_s(NULL, ", ", &context)) {
+		for (entry = 0; entry < numEntries; entry++) {
+			if (_stricmp(name, stageTable[entry].name) == 0) {
+				break;
+			}
+		}
+
+		if (entry == numEntries || isListed[entry] || numStages == PIPELINE_MAX_STAGES) {
+			numStages = 0;
+			return 0;
+		}
+
+		isListed[entry] = TRUE;
+		stages[numStages].routine = stageTable[entry].routine;
+		numStages++;
+	}
+
+	if (numStages == 0 || stages[0].routine != DecodeStage) {
+		numStages = 0;
+		return 0;
+	}
+
+	return numStages;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: PostTagEvent
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL PostTagEvent(LPSKYETEK_TAG lpTag, int reader)
+--
+--	RETURNS:		BOOL - FALSE if there was no room and the read was dropped
+--
+--	NOTES:			Called from SelectLoopCallback on the reader's thread. Only copies
+--					the read into the filling batch under the source lock, so its cost
+--					does not depend on the stages configured, and it never waits on a
+--					stage. The batch is sealed once it is full, or
+--					by the flush timer. Drops are counted and shown by the status
+--					stage; readers check PipelineHasRoom before each pass so that
+--					reads are not normally dropped.
+-----------------------------------------------------------------------------------*/
+BOOL PostTagEvent(LPSKYETEK_TAG lpTag, int reader) {
+	LPTAG_EVENT lpEvent;
+
+	EnterCriticalSection(&sourceLock);
+
+	if (lpFilling == NULL && numFreeBatches > 0) {
+		lpFilling = freeBatches[--numFreeBatches];
+		lpFilling->count = 0;
+		ResetEvent(hDrained);
+	}
+
+	if (lpFilling == NULL) {
+		LeaveCriticalSection(&sourceLock);
+		InterlockedIncrement(&droppedEvents);
+		return FALSE;
+	}
+
+	lpEvent = &lpFilling->events[lpFilling->count++];
+	lpEvent->reader = reader;
+	lpEvent->tick = GetTickCount();
+	lpEvent->type = lpTag->type;
+	memcpy(lpEvent->friendly, lpTag->friendly, min(sizeof(lpEvent->friendly), sizeof(lpTag->friendly)));
+
+	if (lpFilling->count == PIPELINE_BATCH_SIZE) {
+		SealBatch();
+	}
+
+	LeaveCriticalSection(&sourceLock);
+	return TRUE;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: PipelineHasRoom
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL PipelineHasRoom(int events)
+--
+--	RETURNS:		BOOL - TRUE if at least that many reads can be taken
+--
+--	NOTES:			Back-pressure check for the reader sessions, made before each
+--					select pass. Batches only return to the pool once they have passed
+--					every stage, so the room left shrinks while any stage falls behind.
+-----------------------------------------------------------------------------------*/
+BOOL PipelineHasRoom(int events) {
+	int room = 0;
+
+	EnterCriticalSection(&sourceLock);
+
+	if (lpFilling != NULL) {
+		room = PIPELINE_BATCH_SIZE - lpFilling->count;
+	}
+	room += numFreeBatches * PIPELINE_BATCH_SIZE;
+
+	LeaveCriticalSection(&sourceLock);
+	return (room >= events);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: PipelineWorker
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		DWORD WINAPI PipelineWorker(LPVOID lpParameter)
+--
+--	RETURNS:		DWORD
+--
+--	NOTES:			Thread function of every pipeline thread. Each completion packet
+--					carries the index of a stage to run, plus one, or
+--					PIPELINE_FEED_KEY to feed sealed batches to the first stage; an
+--					empty packet ends the thread.
+-----------------------------------------------------------------------------------*/
+DWORD WINAPI PipelineWorker(LPVOID lpParameter) {
+	DWORD bytes;
+	ULONG_PTR key;
+	LPOVERLAPPED lpOverlapped;
+
+	while (GetQueuedCompletionStatus(hPipelinePort, &bytes, &key, &lpOverlapped, INFINITE)) {
+		if (key == 0) {
+			break;
+		}
+
+		if (key == PIPELINE_FEED_KEY) {
+			RunFeed();
+		} else {
+			RunStage((int)key - 1);
+		}
+	}
+
+	return 0;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: RunStage
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void RunStage(int index)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Runs a stage over every batch in its queue, outside the lock, and
+--					passes each batch on to the next stage. If the next queue is full
+--					the batch is held as lpBlocked and the stage stops; the next stage
+--					moves it on and schedules this one again once it makes room.
+-----------------------------------------------------------------------------------*/
+void RunStage(int index) {
+	LPPIPELINE_STAGE lpStage = &stages[index];
+	LPTAG_BATCH lpBatch;
+
+	EnterCriticalSection(&pipelineLock);
+
+	while ((lpBatch = PopBatch(index)) != NULL) {
+		LeaveCriticalSection(&pipelineLock);
+
+		if (lpBatch->count > 0) {
+			lpBatch->count = lpStage->routine(lpBatch->events, lpBatch->count);
+		}
+
+		EnterCriticalSection(&pipelineLock);
+
+		if (!PushBatch(index + 1, lpBatch)) {
+			lpStage->lpBlocked = lpBatch;
+			break;
+		}
+	}
+
+	lpStage->isScheduled = FALSE;
+	LeaveCriticalSection(&pipelineLock);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: PopBatch
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		LPTAG_BATCH PopBatch(int index)
+--
+--	RETURNS:		LPTAG_BATCH - oldest batch in the stage's queue, NULL if empty
+--
+--	NOTES:			Takes the oldest batch off a stage's queue, and uses the room made
+--					to take in the batch blocked in front of it, if any. For the first
+--					stage, the room is filled by the next feed. Called with the
+--					pipeline lock held.
+-----------------------------------------------------------------------------------*/
+LPTAG_BATCH PopBatch(int index) {
+	LPPIPELINE_STAGE lpStage = &stages[index];
+	LPTAG_BATCH lpBatch;
+	LPTAG_BATCH lpWaiting;
+
+	if (lpStage->count == 0) {
+		return NULL;
+	}
+
+	lpBatch = lpStage->queue[lpStage->head];
+	lpStage->head = (lpStage->head + 1) % PIPELINE_QUEUE_DEPTH;
+	lpStage->count--;
+
+	if (index == 0) {
+		ScheduleFeed();
+		return lpBatch;
+	}
+
+	lpWaiting = stages[index - 1].lpBlocked;
+
+	if (lpWaiting != NULL) {
+		lpStage->queue[(lpStage->head + lpStage->count) % PIPELINE_QUEUE_DEPTH] = lpWaiting;
+		lpStage->count++;
+		stages[index - 1].lpBlocked = NULL;
+		ScheduleStage(index - 1);
+	}
+
+	return lpBatch;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: PushBatch
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL PushBatch(int index, LPTAG_BATCH lpBatch)
+--
+--	RETURNS:		BOOL - FALSE if the stage's queue is full
+--
+--	NOTES:			Adds a batch to a stage's queue and schedules the stage. A batch
+--					pushed past the last stage goes back to the pool, under the
+--					source lock. Called with the pipeline lock held.
+-----------------------------------------------------------------------------------*/
+BOOL PushBatch(int index, LPTAG_BATCH lpBatch) {
+	LPPIPELINE_STAGE lpStage = &stages[index];
+
+	if (index == numStages) {
+		EnterCriticalSection(&sourceLock);
+		freeBatches[numFreeBatches++] = lpBatch;
+
+		if (numFreeBatches == PIPELINE_BATCHES) {
+			SetEvent(hDrained);
+		}
+		LeaveCriticalSection(&sourceLock);
+		return TRUE;
+	}
+
+	if (lpStage->count == PIPELINE_QUEUE_DEPTH) {
+		return FALSE;
+	}
+
+	lpStage->queue[(lpStage->head + lpStage->count) % PIPELINE_QUEUE_DEPTH] = lpBatch;
+	lpStage->count++;
+	ScheduleStage(index);
+
+	return TRUE;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: ScheduleStage
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void ScheduleStage(int index)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Queues a stage to run on a pipeline thread, unless it is already
+--					queued or running, or is waiting on the next stage. Called with
+--					the pipeline lock held.
+-----------------------------------------------------------------------------------*/
+void ScheduleStage(int index) {
+	LPPIPELINE_STAGE lpStage = &stages[index];
+
+	if (lpStage->isScheduled || lpStage->lpBlocked != NULL) {
+		return;
+	}
+
+	lpStage->isScheduled = TRUE;
+	PostQueuedCompletionStatus(hPipelinePort, 0, (ULONG_PTR)index + 1, NULL);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SealBatch
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void SealBatch(void)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Adds the filling batch to the sealed batches and schedules a feed,
+--					which moves it into the first stage's queue. Called with the
+--					source lock held.
+-----------------------------------------------------------------------------------*/
+void SealBatch(void) {
+	if (lpFilling == NULL || lpFilling->count == 0) {
+		return;
+	}
+
+	sealedBatches[(sealedHead + numSealed) % PIPELINE_BATCHES] = lpFilling;
+	numSealed++;
+	lpFilling = NULL;
+
+	ScheduleFeed();
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: ScheduleFeed
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void ScheduleFeed(void)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Queues a feed on a pipeline thread, unless one is already queued.
+--					Needs neither lock, so it can be called under either.
+-----------------------------------------------------------------------------------*/
+void ScheduleFeed(void) {
+	if (InterlockedExchange(&feedScheduled, TRUE) == FALSE) {
+		PostQueuedCompletionStatus(hPipelinePort, 0, PIPELINE_FEED_KEY, NULL);
+	}
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: RunFeed
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void RunFeed(void)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Moves sealed batches, oldest first, into the first stage's queue
+--					until it is full. The batches left are fed once the first stage
+--					takes a batch off its queue.
+-----------------------------------------------------------------------------------*/
+void RunFeed(void) {
+	LPTAG_BATCH lpBatch;
+
+	// cleared first, so a batch sealed from here on schedules another feed
+	InterlockedExchange(&feedScheduled, FALSE);
+
+	EnterCriticalSection(&pipelineLock);
+
+	while (stages[0].count < PIPELINE_QUEUE_DEPTH) {
+		EnterCriticalSection(&sourceLock);
+
+		lpBatch = NULL;
+		if (numSealed > 0) {
+			lpBatch = sealedBatches[sealedHead];
+			sealedHead = (sealedHead + 1) % PIPELINE_BATCHES;
+			numSealed--;
+		}
+
+		LeaveCriticalSection(&sourceLock);
+
+		if (lpBatch == NULL) {
+			break;
+		}
+
+		PushBatch(0, lpBatch);
+	}
+
+	LeaveCriticalSection(&pipelineLock);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: FlushTimerCallback
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void CALLBACK FlushTimerCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Runs every PIPELINE_FLUSH_PERIOD, so reads arriving slowly are
+--					not held back waiting for a full batch.
+-----------------------------------------------------------------------------------*/
+void CALLBACK FlushTimerCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired) {
+	EnterCriticalSection(&sourceLock);
+	SealBatch();
+	LeaveCriticalSection(&sourceLock);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DecodeStage
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		int DecodeStage(LPTAG_EVENT lpEvents, int count)
+--
+--	RETURNS:		int - number of events kept
+--
+--	NOTES:			Fills in the tag ID and type text, as SelectLoopCallback used to.
+--					The type name is only looked up when the type changes.
+-----------------------------------------------------------------------------------*/
+int DecodeStage(LPTAG_EVENT lpEvents, int count) {
+	SKYETEK_TAGTYPE lastType = AUTO_DETECT;
+	TCHAR *lpTypeName = NULL;
+
+	for (int i = 0; i < count; i++) {
+		LPTAG_EVENT lpEvent = &lpEvents[i];
+		size_t length = 0;
+
+		// get friendly text from tag, skipping empty characters
+		for (int j = 0; j < TAG_ID_LENGTH && length < sizeof(lpEvent->id) - 1; j++) {
+			if (lpEvent->friendly[j] != '\0') {
+				lpEvent->id[length++] = (char)lpEvent->friendly[j];
+			}
+		}
+		lpEvent->id[length] = '\0';
+
+		// get type text from tag
+		if (lpTypeName == NULL || lpEvent->type != lastType) {
+			lpTypeName = SkyeTek_GetTagTypeNameFromType(lpEvent->type);
+			lastType = lpEvent->type;
+		}
+		sprintf_s(lpEvent->typeName, "%s", (lpTypeName != NULL) ? lpTypeName : "");
+	}
+
+	return count;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DedupeStage
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		int DedupeStage(LPTAG_EVENT lpEvents, int count)
+--
+--	RETURNS:		int - number of events kept
+--
+--	NOTES:			Drops a read of a tag, by the same reader, if that reader last read
+--					it within PIPELINE_DEDUPE_WINDOW. Stops tags left in the field from
+--					filling the list, even when several are read in turn. The last
+--					read of each tag is kept in a fixed table, looked up by a hash of
+--					the reader and tag ID; when all PIPELINE_DEDUPE_PROBES slots for a
+--					tag are live, the oldest is replaced. Must follow decode.
+-----------------------------------------------------------------------------------*/
+int DedupeStage(LPTAG_EVENT lpEvents, int count) {
+	int kept = 0;
+
+	for (int i = 0; i < count; i++) {
+		LPTAG_EVENT lpEvent = &lpEvents[i];
+		LPDEDUPE_ENTRY lpEntry = NULL;
+		LPDEDUPE_ENTRY lpOldest = NULL;
+		unsigned int hash = 2166136261u ^ (unsigned int)lpEvent->reader;
+
+		// FNV-1a over the tag ID, seeded with the reader
+		for (const char *c = lpEvent->id; *c != '\0'; c++) {
+			hash = (hash ^ (unsigned char)*c) * 16777619u;
+		}
+
+		for (int probe = 0; probe < PIPELINE_DEDUPE_PROBES; probe++) {
+			LPDEDUPE_ENTRY lpSlot = &dedupeTable[(hash + probe) % PIPELINE_DEDUPE_SLOTS];
+
+			if (lpSlot->isUsed && lpSlot->reader == lpEvent->reader && strcmp(lpSlot->id, lpEvent->id) == 0) {
+				lpEntry = lpSlot;
+				break;
+			}
+
+			if (lpOldest == NULL || !lpSlot->isUsed
+				|| (lpOldest->isUsed && lpEvent->tick - lpSlot->tick > lpEvent->tick - lpOldest->tick)) {
+				lpOldest = lpSlot;
+			}
+		}
+
+		if (lpEntry != NULL && lpEvent->tick - lpEntry->tick < PIPELINE_DEDUPE_WINDOW) {
+			lpEntry->tick = lpEvent->tick;
+			continue;
+		}
+
+		if (lpEntry == NULL) {
+			lpEntry = lpOldest;
+			lpEntry->isUsed = TRUE;
+			lpEntry->reader = lpEvent->reader;
+			strcpy_s(lpEntry->id, lpEvent->id);
+		}
+		lpEntry->tick = lpEvent->tick;
+
+		if (kept != i) {
+			lpEvents[kept] = *lpEvent;
+		}
+		kept++;
+	}
+
+	return kept;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DisplayStage
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		int DisplayStage(LPTAG_EVENT lpEvents, int count)
+--
+--	RETURNS:		int - number of events kept
+--
+--	NOTES:			Appends a row to the listview for each event, and fills in the
+--					row at the index the listview gave it. Redrawing is turned off for
+--					the batch, so the listview repaints once per batch rather than
+--					once per row. Must follow decode.
+-----------------------------------------------------------------------------------*/
+int DisplayStage(LPTAG_EVENT lpEvents, int count) {
+	char counterBuffer[40];
+	LVITEM row;
+	int rowIndex;
+	int tagCount;
+
+	SendMessage(hwndListView, WM_SETREDRAW, FALSE, 0);
+
+	for (int i = 0; i < count; i++) {
+		// append the row; the listview decides its index, as the Clear button
+		// may empty the list or reset the counter at any time
+		tagCount = InterlockedIncrement(&listCounter) - 1;
+		row = lv;
+		row.iItem = tagCount;
+		rowIndex = ListView_InsertItem(hwndListView, &row);
+		if (rowIndex < 0) {
+			continue;
+		}
+		sprintf_s(counterBuffer, "%d", tagCount);
+
+		// sets counter, id, and type (displays on screen)
+		ListView_SetItemText(hwndListView, rowIndex, 0, counterBuffer);
+		ListView_SetItemText(hwndListView, rowIndex, 1, lpEvents[i].id);
+		ListView_SetItemText(hwndListView, rowIndex, 2, lpEvents[i].typeName);
+	}
+
+	SendMessage(hwndListView, WM_SETREDRAW, TRUE, 0);
+	InvalidateRect(hwndListView, NULL, FALSE);
+
+	return count;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: StatusStage
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		int StatusStage(LPTAG_EVENT lpEvents, int count)
+--
+--	RETURNS:		int - number of events kept
+--
+--	NOTES:			Updates the status bar once per batch, with the number of tags
+--					shown and any reads dropped because the pipeline was full.
+-----------------------------------------------------------------------------------*/
+int StatusStage(LPTAG_EVENT lpEvents, int count) {
+	char statusText[1000];
+
+	if (droppedEvents > 0) {
+		sprintf_s(statusText, "Reading tags..... (%ld tags, %ld dropped)", listCounter, droppedEvents);
+	} else {
+		sprintf_s(statusText, "Reading tags..... (%ld tags)", listCounter);
+	}
+	DrawToStatusBar(statusText);
+
+	return count;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: ExportStage
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		int ExportStage(LPTAG_EVENT lpEvents, int count)
+--
+--	RETURNS:		int - number of events kept
+--
+--	NOTES:			Appends each event to PIPELINE_EXPORT_FILE as a line of comma
+--					separated values: tick count, reader, tag ID and tag type. The
+--					file is opened once per batch. Must follow decode.
+-----------------------------------------------------------------------------------*/
+int ExportStage(LPTAG_EVENT lpEvents, int count) {
+	FILE *file;
+
+	if (fopen_s(&file, PIPELINE_EXPORT_FILE, "a") != 0) {
+		return count;
+	}
+
+	for (int i = 0; i < count; i++) {
+		fprintf(file, "%lu,%d,%s,%s\n", lpEvents[i].tick, lpEvents[i].reader,
+			lpEvents[i].id, lpEvents[i].typeName);
+	}
+
+	fclose(file);
+	return count;
+}
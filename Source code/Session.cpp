@@ -5,12 +5,40 @@
 --	PROGRAM:        RFID Reader Application
 --
 --	FUNCTIONS:
---					void DiscoverDevices(LPVOID lpParameter)
---					void StopScanning(HANDLE thread)
+--					BOOL InitSessionPool(int numThreads)
+--					void ShutdownSessionPool(void)
+--					BOOL QueueSessionWork(SESSION_ROUTINE routine, LPVOID lpContext)
+--					HANDLE StartScanning(void)
+--					HANDLE StopScanning(void)
+--					DWORD WINAPI SessionWorker(LPVOID lpParameter)
+--					void DiscoverDevices(LPVOID lpContext)
+--					void SelectStep(LPVOID lpContext)
+--					BOOL ProbeReader(LPREADER_SESSION lpSession)
+--					void BeginRecovery(LPREADER_SESSION lpSession)
+--					void ReconnectStep(LPVOID lpContext)
+--					void DelaySessionWork(LPREADER_SESSION lpSession,
+--						SESSION_ROUTINE routine, DWORD delay)
+--					void CALLBACK DelayTimerCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
+--					void DelayedStep(LPVOID lpContext)
+--					void BeginReaderCall(LPREADER_SESSION lpSession)
+--					BOOL EndReaderCall(LPREADER_SESSION lpSession)
+--					void CALLBACK WatchdogCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
+--					void EndSession(LPREADER_SESSION lpSession)
+--					void CALLBACK StopTimeoutCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
 --
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Scanning runs as pooled, non-blocking reader
+--								   sessions instead of one thread blocked in
+--								   SkyeTek_SelectTags, stopped without
+--								   TerminateThread.
+--					October 19, 2026 - Added the reader watchdog, and reconnecting
+--								   a failed reader without rediscovery.
+--					October 19, 2026 - Sessions hold off selecting while the tag
+--								   event pipeline is full.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -25,6 +53,19 @@
 --					up the Session layer of this model, responsible for handling
 --					initializing and terminating user sessions, allowing users to
 --					start and stop scanning from the RFID reader.
+--
+--					All session work runs on a small fixed pool of threads fed by an
+--					I/O completion port. Discovery is one work item; after it, every
+--					reader found gets its own session, and each select pass of that
+--					session is a separate work item, so any number of readers share
+--					the same SESSION_POOL_THREADS threads. StartScanning and
+--					StopScanning return event handles that are signalled when the
+--					operation completes, and can be waited on by the caller.
+--
+--					A reader that drops off mid-scan is detected by a heartbeat probe
+--					after a read gap, by I/O errors, or by the watchdog when a call
+--					stalls. Only that reader's device is reopened, with exponential
+--					backoff, and its session carries on where it left off.
 -----------------------------------------------------------------------------------*/
 
 #define STRICT
@@ -34,15 +75,46 @@
 #include <stdlib.h>
 #include "header.h"
 
+// function prototype
+DWORD WINAPI SessionWorker(LPVOID lpParameter);
+void DiscoverDevices(LPVOID lpContext);
+void SelectStep(LPVOID lpContext);
+void EndSession(LPREADER_SESSION lpSession);
+BOOL ProbeReader(LPREADER_SESSION lpSession);
+void BeginRecovery(LPREADER_SESSION lpSession);
+void ReconnectStep(LPVOID lpContext);
+void DelaySessionWork(LPREADER_SESSION lpSession, SESSION_ROUTINE routine, DWORD delay);
+void DelayedStep(LPVOID lpContext);
+void BeginReaderCall(LPREADER_SESSION lpSession);
+BOOL EndReaderCall(LPREADER_SESSION lpSession);
+void CALLBACK DelayTimerCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired);
+void CALLBACK WatchdogCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired);
+void CALLBACK StopTimeoutCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired);
+
+// declared variables
 LPSKYETEK_DEVICE *devices = NULL;
 LPSKYETEK_READER *readers = NULL;
+LPREADER_SESSION sessions = NULL;
 int numDevices = 0;
 int numReaders = 0;
 
+HANDLE hCompletionPort = NULL;
+HANDLE poolThreads[SESSION_POOL_THREADS];
+int numPoolThreads = 0;
+
+HANDLE hDiscovered = NULL;	// signalled once discovery has finished
+HANDLE hStopped = NULL;		// signalled once every session has ended
+HANDLE hStopWait = NULL;
+HANDLE hWatchdog = NULL;	// periodic stall check, running while sessions exist
+volatile LONG isScanning = 0;
+volatile LONG activeSessions = 0;
+volatile LONG stopRequested = 0;
+__declspec(thread) HANDLE hWorkerThread = NULL;	// this pool thread, as the watchdog cancels its calls
+
 /*-----------------------------------------------------------------------------------
---	FUNCTION: DiscoverDevices
+--	FUNCTION: InitSessionPool
 --
---	DATE:			October 19, 2015
+--	DATE:			October 19, 2026
 --
 --	REVISIONS:		N/A
 --
@@ -50,20 +122,225 @@ int numReaders = 0;
 --
 --	PROGRAMMER:		Alvin Man / Oscar Kwan
 --
---	INTERFACE:		DWORD WINAPI DiscoverDevices(LPVOID lpParameter)
+--	INTERFACE:		BOOL InitSessionPool(int numThreads)
+--
+--	RETURNS:		BOOL - TRUE if the completion port and threads were created
+--
+--	NOTES:			Creates the completion port used as the session work queue, and
+--					the worker threads that service it. Called once at startup.
+-----------------------------------------------------------------------------------*/
+BOOL InitSessionPool(int numThreads) {
+	if (numThreads > SESSION_POOL_THREADS) {
+		numThreads = SESSION_POOL_THREADS;
+	}
+
+	hCompletionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, numThreads);
+	if (hCompletionPort == NULL) {
+		return FALSE;
+	}
+
+	// both events start signalled, as nothing is discovering or running yet
+	hDiscovered = CreateEvent(NULL, TRUE, TRUE, NULL);
+	hStopped = CreateEvent(NULL, TRUE, TRUE, NULL);
+
+	for (numPoolThreads = 0; numPoolThreads < numThreads; numPoolThreads++) {
+		poolThreads[numPoolThreads] = CreateThread(NULL, 0, SessionWorker, NULL, 0, NULL);
+		if (poolThreads[numPoolThreads] == NULL) {
+			break;
+		}
+	}
+
+	return (numPoolThreads > 0);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: ShutdownSessionPool
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void ShutdownSessionPool(void)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Stops any running sessions, then posts one empty packet per worker
+--					thread so each leaves its loop, and waits for them to exit. Called
+--					on the UI thread once the message loop has ended, so the waits
+--					keep dispatching messages and give up after SESSION_STOP_TIMEOUT.
+--					If a session or worker is still stuck in a reader call, the port
+--					and events it uses are left open for the process exit to reclaim.
+-----------------------------------------------------------------------------------*/
+void ShutdownSessionPool(void) {
+	BOOL isIdle;
+
+	InterlockedExchange(&stopRequested, 1);
+
+	if (hStopWait != NULL) {
+		UnregisterWait(hStopWait);
+		hStopWait = NULL;
+	}
+
+	isIdle = WaitAndPumpMessages(hDiscovered, SESSION_STOP_TIMEOUT)
+		&& WaitAndPumpMessages(hStopped, SESSION_STOP_TIMEOUT);
+
+	for (int i = 0; i < numPoolThreads; i++) {
+		PostQueuedCompletionStatus(hCompletionPort, 0, 0, NULL);
+	}
+
+	for (int i = 0; i < numPoolThreads; i++) {
+		if (!WaitAndPumpMessages(poolThreads[i], SESSION_STOP_TIMEOUT)) {
+			isIdle = FALSE;
+		}
+	}
+
+	if (!isIdle) {
+		return;
+	}
+
+	for (int i = 0; i < numPoolThreads; i++) {
+		CloseHandle(poolThreads[i]);
+	}
+
+	CloseHandle(hCompletionPort);
+	CloseHandle(hDiscovered);
+	CloseHandle(hStopped);
+	numPoolThreads = 0;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: QueueSessionWork
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL QueueSessionWork(SESSION_ROUTINE routine, LPVOID lpContext)
+--
+--	RETURNS:		BOOL - TRUE if the work item was queued
+--
+--	NOTES:			Queues a routine to be run by the next free pool thread. The
+--					routine is passed as the completion key and its context as the
+--					overlapped pointer.
+-----------------------------------------------------------------------------------*/
+BOOL QueueSessionWork(SESSION_ROUTINE routine, LPVOID lpContext) {
+	return PostQueuedCompletionStatus(hCompletionPort, 0, (ULONG_PTR)routine,
+		(LPOVERLAPPED)lpContext);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SessionWorker
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		DWORD WINAPI SessionWorker(LPVOID lpParameter)
 --
 --	RETURNS:		DWORD
 --
---	NOTES:			Uses the SkyeTek API to search for an RFID reader.  If found, the
---					program enters a loop to scan for RFID tags in the vicinity. When
---					a tag is found, the SelectLoopCallback function is called.
---					
---					This function is called inside a new thread when the user initiates
---					a new scanning session.
+--	NOTES:			Thread function of every pool thread. Takes work items off the
+--					completion port and runs them, until an empty packet is received.
+--					Keeps a real handle to itself, which the watchdog uses to cancel
+--					a reader call stalled on this thread.
+-----------------------------------------------------------------------------------*/
+DWORD WINAPI SessionWorker(LPVOID lpParameter) {
+	DWORD bytes;
+	ULONG_PTR key;
+	LPOVERLAPPED lpOverlapped;
+
+	DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &hWorkerThread,
+		0, FALSE, DUPLICATE_SAME_ACCESS);
+
+	while (GetQueuedCompletionStatus(hCompletionPort, &bytes, &key, &lpOverlapped, INFINITE)) {
+		if (key == 0) {
+			break;
+		}
+
+		((SESSION_ROUTINE)key)((LPVOID)lpOverlapped);
+	}
+
+	CloseHandle(hWorkerThread);
+	return 0;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: StartScanning
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		HANDLE StartScanning(void)
+--
+--	RETURNS:		HANDLE - event signalled once discovery has finished
+--
+--	NOTES:			Queues device discovery and returns immediately. Called when the
+--					user clicks the 'Start Scanning' button. Does nothing if a scan
+--					is already running.
+-----------------------------------------------------------------------------------*/
+HANDLE StartScanning(void) {
+	if (InterlockedCompareExchange(&isScanning, 1, 0) != 0) {
+		DrawToStatusBar("Already scanning. Click Stop to stop scanning.");
+		return hDiscovered;
+	}
+
+	InterlockedExchange(&stopRequested, 0);
+	ResetEvent(hDiscovered);
+	ResetEvent(hStopped);
+
+	if (!QueueSessionWork(DiscoverDevices, NULL)) {
+		DrawToStatusBar("Unable to start scanning.....");
+		SetEvent(hDiscovered);
+		SetEvent(hStopped);
+		InterlockedExchange(&isScanning, 0);
+	}
+
+	return hDiscovered;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DiscoverDevices
+--
+--	DATE:			October 19, 2015
+--
+--	REVISIONS:		October 19, 2026 - Runs as a pool work item, and queues one
+--								   session per reader instead of selecting
+--								   from the first reader in place.
+--					October 19, 2026 - Starts the reader watchdog.
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void DiscoverDevices(LPVOID lpContext)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Uses the SkyeTek API to search for RFID readers. For every reader
+--					found, a session is created and its first select pass is queued.
+--					When a tag is found, the SelectLoopCallback function is called.
+--
+--					The SkyeTek discovery calls cannot be cancelled, so a Stop issued
+--					during discovery takes effect once they return.
 -----------------------------------------------------------------------------------*/
-DWORD WINAPI DiscoverDevices(LPVOID lpParameter) {
-	int ix = 0;
-	
+void DiscoverDevices(LPVOID lpContext) {
 	DrawToStatusBar("Discovering devices..... (Takes around 5 seconds)");
 	numDevices = SkyeTek_DiscoverDevices(&devices);
 
@@ -76,18 +353,521 @@ DWORD WINAPI DiscoverDevices(LPVOID lpParameter) {
 
 	if (numReaders == 0) {
 		DrawToStatusBar("No readers found.....");
+	}
+
+	if (numReaders && !stopRequested) {
+		sessions = (LPREADER_SESSION)calloc(numReaders, sizeof(READER_SESSION));
+	}
+
+	if (sessions == NULL) {
+		SkyeTek_FreeReaders(readers, numReaders);
 		SkyeTek_FreeDevices(devices, numDevices);
+		readers = NULL;
+		devices = NULL;
+		numReaders = 0;
+		numDevices = 0;
+
+		if (stopRequested) {
+			DrawToStatusBar("Scanning stopped. Click Start to start scanning again.");
+		}
+
+		SetEvent(hDiscovered);
+		InterlockedExchange(&isScanning, 0);
+		SetEvent(hStopped);
+		return;
 	}
 
-	if (numReaders) {
-		DrawToStatusBar("Reader found, ready to start reading tags.....");
-		SkyeTek_SelectTags(readers[0], AUTO_DETECT, SelectLoopCallback, 0, 1, NULL);
+	DrawToStatusBar("Reader found, ready to start reading tags.....");
+	activeSessions = numReaders;
+
+	for (int i = 0; i < numReaders; i++) {
+		sessions[i].lpReader = readers[i];
+		sessions[i].lpDevice = readers[i]->lpDevice;
+		sessions[i].index = i;
+		sessions[i].isOpen = TRUE;
+		sessions[i].lastHeartbeat = GetTickCount();
+		InitializeCriticalSection(&sessions[i].callLock);
+	}
+
+	// the watchdog and discovered event must be set up before the first session is
+	// queued, as the sessions may all end before this function would get to them
+	CreateTimerQueueTimer(&hWatchdog, NULL, WatchdogCallback, NULL, SESSION_WATCHDOG_PERIOD,
+		SESSION_WATCHDOG_PERIOD, WT_EXECUTEDEFAULT);
+	SetEvent(hDiscovered);
+
+	for (int i = 0; i < numReaders; i++) {
+		QueueSessionWork(SelectStep, &sessions[i]);
+	}
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: SelectStep
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		October 19, 2026 - Probes the reader after a read gap, and hands
+--								   the session to recovery on a fault.
+--					October 19, 2026 - Waits while the tag event pipeline is full.
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void SelectStep(LPVOID lpContext)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Runs a single, non-looping select pass on the session's reader,
+--					then queues the next pass. If no tag was in the field, the next
+--					pass is delayed by SESSION_IDLE_DELAY on the timer queue so that
+--					an idle reader does not hold a pool thread. Ends the session once
+--					Stop has been requested.
+--
+--					When no tag has been read for SESSION_HEARTBEAT, the reader is
+--					probed before the next pass, so a quiet field is told apart from
+--					a dead link. A failed probe, an I/O error, or a pass cancelled as
+--					stalled by the watchdog starts recovery.
+-----------------------------------------------------------------------------------*/
+void SelectStep(LPVOID lpContext) {
+	LPREADER_SESSION lpSession = (LPREADER_SESSION)lpContext;
+	SKYETEK_STATUS status;
+	BOOL isStalled;
+
+	if (stopRequested) {
+		EndSession(lpSession);
+		return;
+	}
+
+	// back-pressure, wait while the tag event pipeline could not take a read from every reader
+	if (!PipelineHasRoom(numReaders)) {
+		DelaySessionWork(lpSession, SelectStep, SESSION_IDLE_DELAY);
+		return;
+	}
+
+	if (GetTickCount() - lpSession->lastHeartbeat > SESSION_HEARTBEAT) {
+		if (!ProbeReader(lpSession)) {
+			BeginRecovery(lpSession);
+			return;
+		}
+	}
+
+	BeginReaderCall(lpSession);
+	status = SkyeTek_SelectTags(lpSession->lpReader, AUTO_DETECT, SelectLoopCallback, 0, 0, lpSession);
+	isStalled = !EndReaderCall(lpSession);
+
+	if (stopRequested) {
+		EndSession(lpSession);
+		return;
+	}
+
+	if (isStalled || status == SKYETEK_READER_IO_ERROR || status == SKYETEK_INVALID_READER) {
+		BeginRecovery(lpSession);
+		return;
+	}
+
+	if (status == SKYETEK_SUCCESS) {
+		lpSession->lastHeartbeat = GetTickCount();
+		QueueSessionWork(SelectStep, lpSession);
+	} else {
+		DelaySessionWork(lpSession, SelectStep, SESSION_IDLE_DELAY);
+	}
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: ProbeReader
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL ProbeReader(LPREADER_SESSION lpSession)
+--
+--	RETURNS:		BOOL - TRUE if the reader answered
+--
+--	NOTES:			Heartbeat check. Asks the reader for its firmware version, which
+--					any connected reader answers whether or not a tag is in the field.
+-----------------------------------------------------------------------------------*/
+BOOL ProbeReader(LPREADER_SESSION lpSession) {
+	LPSKYETEK_DATA lpData = NULL;
+
+	BeginReaderCall(lpSession);
+	SKYETEK_STATUS status = SkyeTek_GetSystemParameter(lpSession->lpReader, SYS_FIRMWARE, &lpData);
+	BOOL isStalled = !EndReaderCall(lpSession);
+
+	if (lpData != NULL) {
+		SkyeTek_FreeData(lpData);
+	}
+
+	if (status != SKYETEK_SUCCESS || isStalled) {
+		return FALSE;
+	}
+
+	lpSession->lastHeartbeat = GetTickCount();
+	return TRUE;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: BeginRecovery
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void BeginRecovery(LPREADER_SESSION lpSession)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Marks the session as faulted and queues the first reconnect
+--					attempt. The session keeps its place in the session list, so
+--					no rediscovery is needed. The notice stays in the recovery part
+--					of the status bar until the reader is reconnected.
+-----------------------------------------------------------------------------------*/
+void BeginRecovery(LPREADER_SESSION lpSession) {
+	char statusText[1000];
+
+	// the watchdog may already have flagged this session, keep its fault time
+	if (InterlockedExchange(&lpSession->isFaulted, TRUE) == FALSE) {
+		lpSession->faultTick = GetTickCount();
+	}
+
+	// shown in the recovery part, as the tag count updates from other readers
+	// keep replacing the message part
+	sprintf_s(statusText, "Reader %d not responding, reconnecting.....", lpSession->index);
+	DrawToStatusBarPart(STATUS_PART_RECOVERY, statusText);
+
+	lpSession->backoff = SESSION_RECONNECT_MIN;
+	QueueSessionWork(ReconnectStep, lpSession);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: ReconnectStep
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void ReconnectStep(LPVOID lpContext)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Closes the session's own device, if it is still open, then reopens
+--					it and creates a new reader on it. The open and create calls are
+--					watched for stalls like a select pass. On success the new reader
+--					replaces the old one in both the session and the reader list, the
+--					reconnect count and time from the fault are shown in the recovery
+--					part of the status bar, and select passes resume. On failure the
+--					attempt is retried after a backoff that doubles up to
+--					SESSION_RECONNECT_MAX.
+--
+--					Reads are delivered from inside the select pass, and a session
+--					never has a pass and a reconnect in flight together, so no read
+--					is dropped or delivered twice across a reconnect.
+-----------------------------------------------------------------------------------*/
+void ReconnectStep(LPVOID lpContext) {
+	LPREADER_SESSION lpSession = (LPREADER_SESSION)lpContext;
+	LPSKYETEK_READER lpReader = NULL;
+	SKYETEK_STATUS status;
+	BOOL isStalled;
+	char statusText[1000];
+
+	if (stopRequested) {
+		EndSession(lpSession);
+		return;
+	}
+
+	if (lpSession->isOpen) {
+		SkyeTek_CloseDevice(lpSession->lpDevice);
+		lpSession->isOpen = FALSE;
+	}
+
+	BeginReaderCall(lpSession);
+	status = SkyeTek_OpenDevice(lpSession->lpDevice);
+	isStalled = !EndReaderCall(lpSession);
+
+	// a cancelled open may still have opened the device, which is closed on the next attempt
+	if (status == SKYETEK_SUCCESS) {
+		lpSession->isOpen = TRUE;
+	}
+
+	if (status == SKYETEK_SUCCESS && !isStalled) {
+		BeginReaderCall(lpSession);
+		status = SkyeTek_CreateReader(lpSession->lpDevice, &lpReader);
+		isStalled = !EndReaderCall(lpSession);
+	}
+
+	if (status != SKYETEK_SUCCESS || isStalled) {
+		if (lpReader != NULL) {
+			SkyeTek_FreeReader(lpReader);
+		}
+
+		DelaySessionWork(lpSession, ReconnectStep, lpSession->backoff);
+		lpSession->backoff = min(lpSession->backoff * 2, (DWORD)SESSION_RECONNECT_MAX);
+		return;
+	}
+
+	SkyeTek_FreeReader(lpSession->lpReader);
+	lpSession->lpReader = lpReader;
+	readers[lpSession->index] = lpReader;
+	lpSession->recoveries++;
+	lpSession->lastHeartbeat = GetTickCount();
+	lpSession->lastRecovery = lpSession->lastHeartbeat - lpSession->faultTick;
+
+	sprintf_s(statusText, "Reader %d reconnected, reading tags.....", lpSession->index);
+	DrawToStatusBar(statusText);
+
+	// kept in its own part, so the tag count updates do not overwrite it
+	sprintf_s(statusText, "Reader %d: %d reconnects, last reconnected %lu ms after the fault",
+		lpSession->index, lpSession->recoveries, lpSession->lastRecovery);
+	DrawToStatusBarPart(STATUS_PART_RECOVERY, statusText);
+
+	InterlockedExchange(&lpSession->isFaulted, FALSE);
+	QueueSessionWork(SelectStep, lpSession);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DelaySessionWork
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void DelaySessionWork(LPREADER_SESSION lpSession,
+--						SESSION_ROUTINE routine, DWORD delay)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Queues the session's next step after a delay, using the timer
+--					queue so that no pool thread waits. The step is queued at once if
+--					the timer cannot be created.
+-----------------------------------------------------------------------------------*/
+void DelaySessionWork(LPREADER_SESSION lpSession, SESSION_ROUTINE routine, DWORD delay) {
+	lpSession->nextStep = routine;
+
+	if (!CreateTimerQueueTimer(&lpSession->hDelayTimer, NULL, DelayTimerCallback, lpSession,
+			delay, 0, WT_EXECUTEONLYONCE)) {
+		lpSession->hDelayTimer = NULL;
+		QueueSessionWork(routine, lpSession);
+	}
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DelayTimerCallback
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		October 19, 2026 - Renamed from IdleTimerCallback, and queues
+--								   the session's pending step.
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void CALLBACK DelayTimerCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Timer queue callback that puts a delayed session step back onto
+--					the session pool. The finished timer is deleted by the step itself.
+-----------------------------------------------------------------------------------*/
+void CALLBACK DelayTimerCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired) {
+	LPREADER_SESSION lpSession = (LPREADER_SESSION)lpParameter;
+
+	QueueSessionWork(DelayedStep, lpSession);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: DelayedStep
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void DelayedStep(LPVOID lpContext)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Deletes the timer that queued it and runs the session's pending
+--					step. Runs on the pool, as a timer cannot delete itself without
+--					risking its own callback.
+-----------------------------------------------------------------------------------*/
+void DelayedStep(LPVOID lpContext) {
+	LPREADER_SESSION lpSession = (LPREADER_SESSION)lpContext;
+
+	if (lpSession->hDelayTimer != NULL) {
+		DeleteTimerQueueTimer(NULL, lpSession->hDelayTimer, NULL);
+		lpSession->hDelayTimer = NULL;
+	}
+
+	lpSession->nextStep(lpSession);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: BeginReaderCall
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void BeginReaderCall(LPREADER_SESSION lpSession)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Records that the calling pool thread is about to make a blocking
+--					reader call for the session, so the watchdog can cancel it.
+-----------------------------------------------------------------------------------*/
+void BeginReaderCall(LPREADER_SESSION lpSession) {
+	EnterCriticalSection(&lpSession->callLock);
+	lpSession->hCallThread = hWorkerThread;
+	lpSession->callStarted = GetTickCount();
+	lpSession->isStalled = FALSE;
+	LeaveCriticalSection(&lpSession->callLock);
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: EndReaderCall
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		BOOL EndReaderCall(LPREADER_SESSION lpSession)
+--
+--	RETURNS:		BOOL - FALSE if the watchdog cancelled the call as stalled
+--
+--	NOTES:			Clears the call recorded by BeginReaderCall. Once this returns,
+--					the watchdog can no longer cancel I/O on the calling thread.
+-----------------------------------------------------------------------------------*/
+BOOL EndReaderCall(LPREADER_SESSION lpSession) {
+	BOOL isStalled;
+
+	EnterCriticalSection(&lpSession->callLock);
+	lpSession->hCallThread = NULL;
+	isStalled = lpSession->isStalled;
+	LeaveCriticalSection(&lpSession->callLock);
+
+	return !isStalled;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: WatchdogCallback
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		N/A
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void CALLBACK WatchdogCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Runs every SESSION_WATCHDOG_PERIOD while scanning. A reader call
+--					that has run longer than SESSION_STALL_TIMEOUT is stalled, and
+--					cannot notice it itself. The watchdog marks the call as stalled
+--					and cancels the I/O the pool thread is blocked in, so the call
+--					fails and the session recovers from its own thread, which is the
+--					only one that closes the device. The cancel is repeated every
+--					check until the call returns.
+-----------------------------------------------------------------------------------*/
+void CALLBACK WatchdogCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired) {
+	DWORD now = GetTickCount();
+
+	for (int i = 0; i < numReaders; i++) {
+		LPREADER_SESSION lpSession = &sessions[i];
+
+		EnterCriticalSection(&lpSession->callLock);
+
+		if (lpSession->hCallThread != NULL && now - lpSession->callStarted > SESSION_STALL_TIMEOUT) {
+			if (InterlockedCompareExchange(&lpSession->isFaulted, TRUE, FALSE) == FALSE) {
+				lpSession->faultTick = now;
+			}
+
+			lpSession->isStalled = TRUE;
+			CancelSynchronousIo(lpSession->hCallThread);
+		}
+
+		LeaveCriticalSection(&lpSession->callLock);
+	}
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: EndSession
+--
+--	DATE:			October 19, 2026
+--
+--	REVISIONS:		October 19, 2026 - Stops the watchdog before the sessions are
+--								   freed.
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		void EndSession(LPREADER_SESSION lpSession)
+--
+--	RETURNS:		void
+--
+--	NOTES:			Ends one reader session. The last session to end frees the
+--					readers and devices and signals that scanning has stopped.
+-----------------------------------------------------------------------------------*/
+void EndSession(LPREADER_SESSION lpSession) {
+	if (InterlockedDecrement(&activeSessions) > 0) {
+		return;
+	}
+
+	// wait for a running watchdog check, as it reads the session list
+	if (hWatchdog != NULL) {
+		DeleteTimerQueueTimer(NULL, hWatchdog, INVALID_HANDLE_VALUE);
+		hWatchdog = NULL;
+	}
+
+	for (int i = 0; i < numReaders; i++) {
+		DeleteCriticalSection(&sessions[i].callLock);
 	}
 
-	SkyeTek_FreeDevices(devices, numDevices);
 	SkyeTek_FreeReaders(readers, numReaders);
+	SkyeTek_FreeDevices(devices, numDevices);
+	free(sessions);
+	sessions = NULL;
+	readers = NULL;
+	devices = NULL;
+	numReaders = 0;
+	numDevices = 0;
 
-	return 1;
+	DrawToStatusBar("Scanning stopped. Click Start to start scanning again.");
+	InterlockedExchange(&isScanning, 0);
+	SetEvent(hStopped);
 }
 
 /*-----------------------------------------------------------------------------------
@@ -95,23 +875,68 @@ DWORD WINAPI DiscoverDevices(LPVOID lpParameter) {
 --
 --	DATE:			October 19, 2015
 --
+--	REVISIONS:		October 19, 2026 - Requests the sessions to stop instead of
+--								   terminating the scanning thread.
+--
+--	DESIGNER:		Alvin Man / Oscar Kwan
+--
+--	PROGRAMMER:		Alvin Man / Oscar Kwan
+--
+--	INTERFACE:		HANDLE StopScanning(void)
+--
+--	RETURNS:		HANDLE - event signalled once every session has ended
+--
+--	NOTES:			Asks every reader session to stop after its current select pass,
+--					and returns without waiting. Called when the user clicks the
+--					'Stop Scanning' button. If the sessions have not ended within
+--					SESSION_STOP_TIMEOUT, the user is told the reader is not
+--					responding; the readers are still freed once it does respond.
+-----------------------------------------------------------------------------------*/
+HANDLE StopScanning(void) {
+	if (!isScanning) {
+		DrawToStatusBar("Not scanning. Click Start to start scanning.");
+		return hStopped;
+	}
+
+	if (InterlockedExchange(&stopRequested, 1) != 0) {
+		return hStopped;
+	}
+
+	DrawToStatusBar("Stopping scanning.....");
+
+	if (hStopWait != NULL) {
+		UnregisterWait(hStopWait);
+		hStopWait = NULL;
+	}
+
+	RegisterWaitForSingleObject(&hStopWait, hStopped, StopTimeoutCallback, NULL,
+		SESSION_STOP_TIMEOUT, WT_EXECUTEONLYONCE);
+
+	return hStopped;
+}
+
+/*-----------------------------------------------------------------------------------
+--	FUNCTION: StopTimeoutCallback
+--
+--	DATE:			October 19, 2026
+--
 --	REVISIONS:		N/A
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
 --	PROGRAMMER:		Alvin Man / Oscar Kwan
 --
---	INTERFACE:		StopScanning(HANDLE thread)
+--	INTERFACE:		void CALLBACK StopTimeoutCallback(PVOID lpParameter,
+--						BOOLEAN timerOrWaitFired)
 --
 --	RETURNS:		void
 --
---	NOTES:			Suspends the thread for reading RFID tags.  Called when the user
---					clicks the 'Stop Scanning' button.
+--	NOTES:			Called once the stop event is signalled or SESSION_STOP_TIMEOUT
+--					has passed, whichever comes first. Only the timeout needs to be
+--					reported, as EndSession reports a completed stop.
 -----------------------------------------------------------------------------------*/
-void StopScanning(HANDLE thread) {
-	TerminateThread(thread, 0);
-	DrawToStatusBar("Scanning stopped. Click Start to start scanning again.");
-
-	SkyeTek_FreeDevices(devices, numDevices);
-	SkyeTek_FreeReaders(readers, numReaders);
-}
\ No newline at end of file
+void CALLBACK StopTimeoutCallback(PVOID lpParameter, BOOLEAN timerOrWaitFired) {
+	if (timerOrWaitFired) {
+		DrawToStatusBar("Waiting for the reader to respond, scanning will stop once it does.....");
+	}
+}
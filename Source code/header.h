@@ -7,7 +7,18 @@
 --
 --	DATE:			October 19, 2015
 --
---	REVISIONS:		N/A
+--	REVISIONS:		October 19, 2026 - Added the reader session pool and
+--								   READER_SESSION, replacing the dedicated
+--								   scanning thread.
+--					October 19, 2026 - Added reader fault detection and reconnect
+--								   settings, and the SIMULATED_READER build.
+--					October 19, 2026 - Added the tag event pipeline settings,
+--								   TAG_EVENT, TAG_BATCH, PIPELINE_ROUTINE and
+--								   the pipeline functions.
+--					October 19, 2026 - Added WaitAndPumpMessages for shutdown.
+--					October 19, 2026 - Added the status bar parts and
+--								   DrawToStatusBarPart, and the per-session
+--								   stall tracking fields.
 --
 --	DESIGNER:		Alvin Man / Oscar Kwan
 --
@@ -44,20 +55,140 @@ using namespace std;
 #define IDM_HELP_BUTTON		106
 #define IDM_EXIT_BUTTON		107
 
+#define STATUS_PART_MESSAGE		0		// status bar part for progress messages
+#define STATUS_PART_RECOVERY	1		// status bar part for the last reader reconnect
+#define STATUS_MESSAGE_WIDTH	450		// width of the message part, the recovery part takes the rest
+
+#define SESSION_POOL_THREADS	2		// worker threads shared by all reader sessions
+#define SESSION_IDLE_DELAY		50		// ms before re-selecting when no tag was in the field
+#define SESSION_STOP_TIMEOUT	5000	// ms allowed for all sessions to drain after Stop
+
+#define SESSION_HEARTBEAT		2000	// ms without a read before the reader is probed
+#define SESSION_STALL_TIMEOUT	3000	// ms a single select pass may take before it is stalled
+#define SESSION_WATCHDOG_PERIOD	500		// ms between watchdog checks for stalled passes
+#define SESSION_RECONNECT_MIN	250		// ms before the first reconnect attempt
+#define SESSION_RECONNECT_MAX	4000	// ms cap on the reconnect backoff, below the stop timeout
+
+#define PIPELINE_CONFIG_FILE	".\\RFIDReader.ini"	// pipeline settings, see Presentation.cpp
+#define PIPELINE_STAGES			"decode,display,status"	// stages run when none are configured
+#define PIPELINE_THREADS		2		// worker threads when none are configured
+#define PIPELINE_MAX_THREADS	4
+#define PIPELINE_MAX_STAGES		8
+#define PIPELINE_BATCH_SIZE		64		// tag events per batch
+#define PIPELINE_BATCHES		16		// batches in the pool, bounds memory and events in flight
+#define PIPELINE_QUEUE_DEPTH	4		// batches waiting in front of each stage, at most
+#define PIPELINE_FLUSH_PERIOD	50		// ms before a partly filled batch is sent on
+#define PIPELINE_DRAIN_TIMEOUT	2000	// ms allowed for batches in flight to finish on exit
+#define PIPELINE_DEDUPE_WINDOW	1000	// ms in which the dedupe stage drops a repeated tag
+#define PIPELINE_DEDUPE_SLOTS	256		// tags the dedupe stage remembers, at most
+#define PIPELINE_DEDUPE_PROBES	8		// slots searched for a tag before the oldest is replaced
+#define PIPELINE_EXPORT_FILE	"RFIDReader.csv"
+
+#define TAG_ID_LENGTH			128
+
+typedef void (*SESSION_ROUTINE)(LPVOID lpContext);
+
+// Reader session, one per discovered reader. Sessions never own a thread, each
+// select pass is queued onto the session pool and re-queues itself until Stop.
+// A session only ever has one step (select pass or reconnect) in flight.
+typedef struct {
+	LPSKYETEK_READER lpReader;	// reader this session selects from
+	LPSKYETEK_DEVICE lpDevice;	// device the reader is reopened on after a fault
+	int index;					// position of the reader in the discovered list
+	HANDLE hDelayTimer;			// pending delayed step, NULL if none
+	SESSION_ROUTINE nextStep;	// step queued when hDelayTimer fires
+	CRITICAL_SECTION callLock;	// guards hCallThread, callStarted and isStalled
+	HANDLE hCallThread;			// pool thread blocked in a reader call, NULL if none
+	DWORD callStarted;			// tick count the current reader call began
+	BOOL isStalled;				// set when the watchdog cancels the current call
+	BOOL isOpen;				// TRUE while lpDevice is open, so it is closed only once
+	volatile LONG isFaulted;	// set once a fault is detected, until reconnected
+	DWORD faultTick;			// tick count the fault was detected
+	DWORD lastHeartbeat;		// tick count of the last read or successful probe
+	DWORD backoff;				// ms before the next reconnect attempt
+	int recoveries;				// number of times the reader has been reconnected
+	DWORD lastRecovery;			// ms the last reconnect took, from fault to reconnect
+} READER_SESSION, *LPREADER_SESSION;
+
+// Tag event, one per read. Plain data, so a batch of them is handed from stage to
+// stage without copying or freeing anything.
+typedef struct {
+	int reader;						// index of the reader session that read it
+	DWORD tick;						// tick count of the read
+	SKYETEK_TAGTYPE type;			// tag type, as read
+	TCHAR friendly[TAG_ID_LENGTH];	// tag ID, as read
+	char id[TAG_ID_LENGTH];			// tag ID text, filled in by the decode stage
+	char typeName[TAG_ID_LENGTH];	// tag type text, filled in by the decode stage
+} TAG_EVENT, *LPTAG_EVENT;
+
+typedef struct {
+	int count;
+	TAG_EVENT events[PIPELINE_BATCH_SIZE];
+} TAG_BATCH, *LPTAG_BATCH;
+
+// Pipeline stage, given a batch of events. Returns how many events are kept; a
+// stage that drops events moves the kept ones to the front.
+typedef int (*PIPELINE_ROUTINE)(LPTAG_EVENT lpEvents, int count);
+
 // Global variables
-extern HANDLE tagThreadHandle; // handle for tag read thread
 extern HWND hwnd;            // handle for window
 extern HWND hwndListView;
-extern HDC hdc;
 extern LVCOLUMN lvc;
 extern LVITEM   lv;
-extern int listCounter;
+extern volatile LONG listCounter;
+extern volatile LONG stopRequested;
 
 // Function prototypes
-DWORD WINAPI DiscoverDevices(LPVOID lpParameter);
-int CallSelectTags(LPSKYETEK_READER lpReader);
+BOOL InitSessionPool(int numThreads);
+void ShutdownSessionPool(void);
+BOOL QueueSessionWork(SESSION_ROUTINE routine, LPVOID lpContext);
+HANDLE StartScanning(void);
+HANDLE StopScanning(void);
 unsigned char SelectLoopCallback(LPSKYETEK_TAG lpTag, void *user);
+BOOL InitPipeline(void);
+void ShutdownPipeline(void);
+BOOL PostTagEvent(LPSKYETEK_TAG lpTag, int reader);
+BOOL PipelineHasRoom(int events);
 void DrawToStatusBar(char statusText[1000]);
-void StopScanning(HANDLE thread);
+void DrawToStatusBarPart(int part, char statusText[1000]);
+BOOL WaitAndPumpMessages(HANDLE hObject, DWORD timeout);
+
+#ifdef SIMULATED_READER
+// Building with SIMULATED_READER replaces the SkyeTek calls with simulated
+// readers that randomly disconnect and stall (see Physical.cpp), so fault
+// detection and reconnect can be exercised without hardware.
+unsigned int SimReader_DiscoverDevices(LPSKYETEK_DEVICE **lpDevices);
+unsigned int SimReader_DiscoverReaders(LPSKYETEK_DEVICE *lpDevices, unsigned int count,
+	LPSKYETEK_READER **lpReaders);
+void SimReader_FreeDevices(LPSKYETEK_DEVICE *lpDevices, unsigned int count);
+void SimReader_FreeReaders(LPSKYETEK_READER *lpReaders, unsigned int count);
+SKYETEK_STATUS SimReader_OpenDevice(LPSKYETEK_DEVICE lpDevice);
+SKYETEK_STATUS SimReader_CloseDevice(LPSKYETEK_DEVICE lpDevice);
+SKYETEK_STATUS SimReader_CreateReader(LPSKYETEK_DEVICE lpDevice, LPSKYETEK_READER *lpReader);
+void SimReader_FreeReader(LPSKYETEK_READER lpReader);
+SKYETEK_STATUS SimReader_SelectTags(LPSKYETEK_READER lpReader, SKYETEK_TAGTYPE tagType,
+	SKYETEK_TAG_SELECT_CALLBACK callback, unsigned char inv, unsigned char loop, void *user);
+SKYETEK_STATUS SimReader_GetSystemParameter(LPSKYETEK_READER lpReader,
+	SKYETEK_SYSTEM_PARAMETER parameter, LPSKYETEK_DATA *lpData);
+void SimReader_FreeData(LPSKYETEK_DATA lpData);
+void SimReader_FreeTag(LPSKYETEK_TAG lpTag);
+TCHAR *SimReader_GetTagTypeNameFromType(SKYETEK_TAGTYPE type);
+BOOL SimReader_CancelSynchronousIo(HANDLE hThread);
+
+#define SkyeTek_DiscoverDevices			SimReader_DiscoverDevices
+#define SkyeTek_DiscoverReaders			SimReader_DiscoverReaders
+#define SkyeTek_FreeDevices				SimReader_FreeDevices
+#define SkyeTek_FreeReaders				SimReader_FreeReaders
+#define SkyeTek_OpenDevice				SimReader_OpenDevice
+#define SkyeTek_CloseDevice				SimReader_CloseDevice
+#define SkyeTek_CreateReader			SimReader_CreateReader
+#define SkyeTek_FreeReader				SimReader_FreeReader
+#define SkyeTek_SelectTags				SimReader_SelectTags
+#define SkyeTek_GetSystemParameter		SimReader_GetSystemParameter
+#define SkyeTek_FreeData				SimReader_FreeData
+#define SkyeTek_FreeTag					SimReader_FreeTag
+#define SkyeTek_GetTagTypeNameFromType	SimReader_GetTagTypeNameFromType
+#define CancelSynchronousIo				SimReader_CancelSynchronousIo
+#endif
 
 #endif